@@ -37,6 +37,12 @@
 #include <sstream>
 #include <iomanip>
 #include <type_traits>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <bit>
+#include <algorithm>
+#include <cstdint>
 
 #ifndef POSITION_LIB_NAMESPACE_BEGIN
 #define POSITION_LIB_NAMESPACE_BEGIN namespace position {
@@ -60,6 +66,11 @@
 #define POSITION_LIB_DETAIL_NAMESPACE_REFERENCE detail::
 #endif
 
+#if !defined(POSITION_LIB_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define POSITION_LIB_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
 // **************************************************************** //
 //                                                                  //
 //                                                                  //
@@ -152,6 +163,37 @@ struct position_display_string
     std::string lon;
 };
 
+enum class position_axis
+{
+    lat,
+    lon
+};
+
+enum class position_notation
+{
+    unknown,
+    dd,
+    ddm,
+    dms
+};
+
+enum class position_parse_status
+{
+    ok,
+    empty,
+    invalid_format,
+    invalid_hemisphere,
+    out_of_range
+};
+
+struct position_parse_result
+{
+    position_dd position;
+    position_parse_status status = position_parse_status::empty;
+    position_notation lat_notation = position_notation::unknown;
+    position_notation lon_notation = position_notation::unknown;
+};
+
 POSITION_LIB_DETAIL_NAMESPACE_BEGIN
 
 template<typename T, typename ... U>
@@ -191,6 +233,29 @@ POSITION_LIB_DETAIL_NAMESPACE_END
 POSITION_LIB_INLINE double format_number(double n, int p = 2);
 POSITION_LIB_INLINE std::string format_number_to_string(double n, int p = 2);
 
+POSITION_LIB_DETAIL_NAMESPACE_BEGIN
+
+POSITION_LIB_INLINE void append_number(std::string& s, double n, int p);
+POSITION_LIB_INLINE void append_integer(std::string& s, int n);
+
+POSITION_LIB_DETAIL_NAMESPACE_END
+
+// **************************************************************** //
+// PARSING                                                          //
+// **************************************************************** //
+
+POSITION_LIB_INLINE position_parse_status parse_coordinate(std::string_view s, position_axis axis, double& value, position_notation& notation);
+POSITION_LIB_INLINE position_parse_result parse_position(std::string_view lat, std::string_view lon);
+POSITION_LIB_INLINE std::size_t parse_positions(std::string_view buffer, std::vector<position_parse_result>& results);
+POSITION_LIB_INLINE std::vector<position_parse_result> parse_positions(std::string_view buffer);
+
+POSITION_LIB_DETAIL_NAMESPACE_BEGIN
+
+POSITION_LIB_INLINE const char* find_delimiter(const char* first, const char* last);
+POSITION_LIB_INLINE bool parse_decimal(const char* first, const char* last, double& value);
+
+POSITION_LIB_DETAIL_NAMESPACE_END
+
 // **************************************************************** //
 //                                                                  //
 //                                                                  //
@@ -200,33 +265,34 @@ POSITION_LIB_INLINE std::string format_number_to_string(double n, int p = 2);
 // **************************************************************** //
 
 template <POSITION_LIB_DETAIL_NAMESPACE_REFERENCE IsAnyOf<position_dd, position_ddm, position_dms> T>
-POSITION_LIB_INLINE_NO_DISABLE position_display_string format(const T& p, const position_format& format)
+POSITION_LIB_INLINE_NO_DISABLE void format(const T& p, const position_format& format, position_display_string& ps)
 {
-    position_display_string ps;
+    ps.lat.clear();
+    ps.lon.clear();
 
     if constexpr (std::is_same_v<T, position_dd>)
     {
-        ps.lat = format_number_to_string(p.lat, format.lat_precision);        
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lat, p.lat, format.lat_precision);
         ps.lat.append(format.deg_symbol);
-        ps.lon = format_number_to_string(p.lon, format.lon_precision);
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lon, p.lon, format.lon_precision);
         ps.lon.append(format.deg_symbol);
     }
     else if constexpr (std::is_same_v<T, position_ddm>)
     {
-        ps.lat = std::to_string(p.lat_d);
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lat, p.lat_d);
         ps.lat.append(format.deg_symbol);
         ps.lat.append(format.dm_separator);
-        ps.lat.append(format_number_to_string(p.lat_m, format.min_precision));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lat, p.lat_m, format.min_precision);
         ps.lat.append(format.min_symbol);
         if (format.dir_indicator)
         {
             ps.lat.append(format.dir_indicator_spacer);
             ps.lat.append(1, p.lat);
         }
-        ps.lon = std::to_string(p.lon_d);
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lon, p.lon_d);
         ps.lon.append(format.deg_symbol);
         ps.lon.append(format.dm_separator);
-        ps.lon.append(format_number_to_string(p.lon_m, format.min_precision));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lon, p.lon_m, format.min_precision);
         ps.lon.append(format.min_symbol);
         if (format.dir_indicator)
         {
@@ -236,24 +302,24 @@ POSITION_LIB_INLINE_NO_DISABLE position_display_string format(const T& p, const
     }
     else if constexpr (std::is_same_v<T, position_dms>)
     {
-        ps.lat = std::to_string(p.lat_d);
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lat, p.lat_d);
         ps.lat.append(format.deg_symbol);
         ps.lat.append(format.dm_separator);
-        ps.lat.append(std::to_string(p.lat_m));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lat, p.lat_m);
         ps.lat.append(format.min_symbol);
-        ps.lat.append(format_number_to_string(p.lat_s, format.sec_precision));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lat, p.lat_s, format.sec_precision);
         ps.lat.append(format.sec_symbol);
         if (format.dir_indicator)
         {
             ps.lat.append(format.dir_indicator_spacer);
             ps.lat.append(1, p.lat);
         }
-        ps.lon = std::to_string(p.lon_d);
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lon, p.lon_d);
         ps.lon.append(format.deg_symbol);
         ps.lon.append(format.dm_separator);
-        ps.lon.append(std::to_string(p.lon_m));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_integer(ps.lon, p.lon_m);
         ps.lon.append(format.min_symbol);
-        ps.lon.append(format_number_to_string(p.lon_s, format.sec_precision));
+        POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(ps.lon, p.lon_s, format.sec_precision);
         ps.lon.append(format.sec_symbol);
         if (format.dir_indicator)
         {
@@ -261,7 +327,13 @@ POSITION_LIB_INLINE_NO_DISABLE position_display_string format(const T& p, const
             ps.lon.append(1, p.lon);
         }
     }
+}
 
+template <POSITION_LIB_DETAIL_NAMESPACE_REFERENCE IsAnyOf<position_dd, position_ddm, position_dms> T>
+POSITION_LIB_INLINE_NO_DISABLE position_display_string format(const T& p, const position_format& fmt)
+{
+    position_display_string ps;
+    format(p, fmt, ps);
     return ps;
 }
 
@@ -380,25 +452,314 @@ POSITION_LIB_INLINE position_ddm& position_ddm::operator=(const position_dms& p)
 POSITION_LIB_INLINE std::string format_number_to_string(double number, int precision)
 {
     std::string pretty_number_str;
-    if (precision == 0)
+    POSITION_LIB_DETAIL_NAMESPACE_REFERENCE append_number(pretty_number_str, number, precision);
+    return pretty_number_str;
+}
+
+POSITION_LIB_INLINE double format_number(double number, int precision)
+{
+    std::string s = format_number_to_string(number, precision);
+    return std::stod(s);
+}
+
+// **************************************************************** //
+//                                                                  //
+// PARSING                                                          //
+//                                                                  //
+// **************************************************************** //
+
+POSITION_LIB_INLINE position_parse_status parse_coordinate(std::string_view s, position_axis axis, double& value, position_notation& notation)
+{
+    // Accepted notations, with the hemisphere either leading, trailing
+    // or replaced by a sign, and any mix of unit symbols and spaces:
+    //
+    // DD:  -122.3493, 47.6205N, 47.6205°
+    // DDM: 47°37.230'N, 47d37.230', 47 37.230 N, 4851.51N (compact)
+    // DMS: 47°37'13.80"N, 47:37:13.80N, 47 37 13.80 N
+
+    value = 0.0;
+    notation = position_notation::unknown;
+
+    auto is_space = [](char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    while (!s.empty() && is_space(s.front()))
     {
-        double i;
-        std::modf(number, &i);
-        pretty_number_str = std::to_string((int)i);
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && is_space(s.back()))
+    {
+        s.remove_suffix(1);
+    }
+    if (s.empty())
+    {
+        return position_parse_status::empty;
+    }
+
+    auto is_hemisphere = [](char c) { return c == 'N' || c == 'S' || c == 'E' || c == 'W'; };
+
+    double components[3] = {};
+    bool fractional[3] = {};
+    std::size_t int_digits[3] = {};
+    int count = 0;
+    bool last_was_number = false;
+    bool has_deg_symbol = false;
+    bool negative = false;
+    char hemisphere = '\0';
+    std::size_t i = 0;
+    std::size_t n = s.size();
+
+    if (s[0] == '-' || s[0] == '+')
+    {
+        negative = s[0] == '-';
+        i = 1;
+    }
+    else if (is_hemisphere(s[0]))
+    {
+        hemisphere = s[0];
+        i = 1;
+    }
+
+    while (i < n)
+    {
+        char c = s[i];
+
+        if ((c >= '0' && c <= '9') || c == '.')
+        {
+            if (count == 3)
+            {
+                return position_parse_status::invalid_format;
+            }
+            std::size_t j = i;
+            while (j < n && ((s[j] >= '0' && s[j] <= '9') || s[j] == '.'))
+            {
+                j++;
+            }
+            if (!POSITION_LIB_DETAIL_NAMESPACE_REFERENCE parse_decimal(s.data() + i, s.data() + j, components[count]))
+            {
+                return position_parse_status::invalid_format;
+            }
+            int_digits[count] = std::min(s.substr(i, j - i).find('.'), j - i);
+            fractional[count] = int_digits[count] != j - i;
+            count++;
+            last_was_number = true;
+            i = j;
+            continue;
+        }
+
+        if (c == ' ' || c == '\t')
+        {
+            i++;
+            continue;
+        }
+
+        // Unit symbols must directly follow the component they qualify
+        int rank = 0;
+        std::size_t width = 1;
+        if (c == 'd' || c == 'D')
+        {
+            rank = 1;
+        }
+        else if (c == '\'' && i + 1 < n && s[i + 1] == '\'')
+        {
+            rank = 3;
+            width = 2;
+        }
+        else if (c == '\'')
+        {
+            rank = 2;
+        }
+        else if (c == '"')
+        {
+            rank = 3;
+        }
+        else if (c == ':')
+        {
+            rank = count;
+        }
+        else if (c == '\xC2' && i + 1 < n && (s[i + 1] == '\xB0' || s[i + 1] == '\xBA'))
+        {
+            // ° and º
+            rank = 1;
+            width = 2;
+        }
+        else if (c == '\xE2' && i + 2 < n && s[i + 1] == '\x80' && (s[i + 2] == '\xB2' || s[i + 2] == '\xB3'))
+        {
+            // ′ and ″
+            rank = s[i + 2] == '\xB2' ? 2 : 3;
+            width = 3;
+        }
+        else if (is_hemisphere(c) && hemisphere == '\0' && !negative && s[0] != '+' && i + 1 == n)
+        {
+            hemisphere = c;
+            i++;
+            continue;
+        }
+        else
+        {
+            return position_parse_status::invalid_format;
+        }
+
+        if (!last_was_number || rank != count)
+        {
+            return position_parse_status::invalid_format;
+        }
+        has_deg_symbol = has_deg_symbol || (rank == 1 && c != ':');
+        last_was_number = false;
+        i += width;
+    }
+
+    if (count == 0)
+    {
+        return position_parse_status::invalid_format;
+    }
+
+    for (int k = 0; k < count - 1; k++)
+    {
+        if (fractional[k])
+        {
+            return position_parse_status::invalid_format;
+        }
+    }
+
+    if (hemisphere != '\0')
+    {
+        bool lat_hemisphere = hemisphere == 'N' || hemisphere == 'S';
+        if (lat_hemisphere != (axis == position_axis::lat))
+        {
+            return position_parse_status::invalid_hemisphere;
+        }
+    }
+
+    double max = axis == position_axis::lat ? 90.0 : 180.0;
+    std::size_t compact_digits = axis == position_axis::lat ? 4 : 5;
+
+    if (count == 1 && hemisphere != '\0' && !has_deg_symbol && int_digits[0] >= compact_digits)
+    {
+        // Compact DDM as used by NMEA and APRS, e.g. 4851.51N or 00217.67E,
+        // recognized by the zero padded degrees which these formats mandate
+        components[1] = std::fmod(components[0], 100.0);
+        components[0] = (components[0] - components[1]) / 100.0;
+        count = 2;
+    }
+
+    if ((count > 1 && components[1] >= 60.0) || (count > 2 && components[2] >= 60.0))
+    {
+        return position_parse_status::out_of_range;
+    }
+
+    double v = components[0];
+    if (count > 1)
+    {
+        v += components[1] / 60.0;
+    }
+    if (count > 2)
+    {
+        v += components[2] / 3600.0;
+    }
+
+    if (v > max)
+    {
+        return position_parse_status::out_of_range;
+    }
+
+    if (negative || hemisphere == 'S' || hemisphere == 'W')
+    {
+        v = -v;
+    }
+
+    value = v;
+    notation = count == 1 ? position_notation::dd : (count == 2 ? position_notation::ddm : position_notation::dms);
+
+    return position_parse_status::ok;
+}
+
+POSITION_LIB_INLINE position_parse_result parse_position(std::string_view lat, std::string_view lon)
+{
+    position_parse_result result;
+
+    position_parse_status lat_status = parse_coordinate(lat, position_axis::lat, result.position.lat, result.lat_notation);
+    position_parse_status lon_status = parse_coordinate(lon, position_axis::lon, result.position.lon, result.lon_notation);
+
+    if (lat_status == position_parse_status::empty && lon_status == position_parse_status::empty)
+    {
+        result.status = position_parse_status::empty;
+    }
+    else if (lat_status != position_parse_status::ok)
+    {
+        result.status = lat_status == position_parse_status::empty ? position_parse_status::invalid_format : lat_status;
+    }
+    else if (lon_status != position_parse_status::ok)
+    {
+        result.status = lon_status == position_parse_status::empty ? position_parse_status::invalid_format : lon_status;
     }
     else
     {
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(precision) << number;
-        pretty_number_str = ss.str();
+        result.status = position_parse_status::ok;
     }
-    return pretty_number_str;
+
+    return result;
 }
 
-POSITION_LIB_INLINE double format_number(double number, int precision)
+POSITION_LIB_INLINE std::size_t parse_positions(std::string_view buffer, std::vector<position_parse_result>& results)
 {
-    std::string s = format_number_to_string(number, precision);
-    return std::stod(s);
+    // One record per line, with the latitude and longitude fields
+    // separated by a comma, semicolon or tab. Every line, including
+    // blank ones, produces one result so that indices match lines.
+
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    std::size_t count = 0;
+
+    while (p < end)
+    {
+        const char* separator = nullptr;
+        bool extra_separator = false;
+        const char* q = p;
+
+        while (true)
+        {
+            q = POSITION_LIB_DETAIL_NAMESPACE_REFERENCE find_delimiter(q, end);
+            if (q == end || *q == '\n')
+            {
+                break;
+            }
+            if (separator == nullptr)
+            {
+                separator = q;
+            }
+            else
+            {
+                extra_separator = true;
+            }
+            q++;
+        }
+
+        position_parse_result result;
+
+        if (separator == nullptr || extra_separator)
+        {
+            std::string_view record(p, q - p);
+            bool blank = record.find_first_not_of(" \t\r") == std::string_view::npos;
+            result.status = blank ? position_parse_status::empty : position_parse_status::invalid_format;
+        }
+        else
+        {
+            result = parse_position(std::string_view(p, separator - p), std::string_view(separator + 1, q - separator - 1));
+        }
+
+        results.push_back(result);
+        count++;
+
+        p = q == end ? end : q + 1;
+    }
+
+    return count;
+}
+
+POSITION_LIB_INLINE std::vector<position_parse_result> parse_positions(std::string_view buffer)
+{
+    std::vector<position_parse_result> results;
+    parse_positions(buffer, results);
+    return results;
 }
 
 // **************************************************************** //
@@ -508,6 +869,118 @@ POSITION_LIB_INLINE std::tuple<int, int, double> dd_to_dms(double dd)
     return std::make_tuple((int)d, (int)m, s);
 }
 
+POSITION_LIB_INLINE void append_number(std::string& s, double number, int precision)
+{
+    // Appends in place with std::to_chars, which rounds the same way as
+    // std::fixed and std::setprecision, without allocating a stream
+
+    if (precision == 0)
+    {
+        double i;
+        std::modf(number, &i);
+        append_integer(s, (int)i);
+        return;
+    }
+
+    char buffer[64];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number, std::chars_format::fixed, precision);
+    if (ec == std::errc())
+    {
+        s.append(buffer, ptr);
+    }
+    else
+    {
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(precision) << number;
+        s.append(ss.str());
+    }
+}
+
+POSITION_LIB_INLINE void append_integer(std::string& s, int number)
+{
+    char buffer[16];
+    auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    s.append(buffer, ptr);
+}
+
+POSITION_LIB_INLINE bool parse_decimal(const char* first, const char* last, double& value)
+{
+    // Parses digits with an optional decimal point. When the mantissa and
+    // the power of ten are both exactly representable, a single division
+    // is correctly rounded, otherwise defer to std::from_chars
+
+    static constexpr double powers_of_10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    std::uint64_t mantissa = 0;
+    int digits = 0;
+    int fraction_digits = 0;
+    bool has_point = false;
+
+    for (const char* p = first; p < last; p++)
+    {
+        if (*p == '.')
+        {
+            if (has_point)
+            {
+                return false;
+            }
+            has_point = true;
+            continue;
+        }
+        mantissa = mantissa * 10 + static_cast<std::uint64_t>(*p - '0');
+        digits++;
+        fraction_digits += has_point ? 1 : 0;
+    }
+
+    if (digits == 0)
+    {
+        return false;
+    }
+
+    if (digits <= 15 && fraction_digits <= 22)
+    {
+        value = static_cast<double>(mantissa) / powers_of_10[fraction_digits];
+        return true;
+    }
+
+    auto [ptr, ec] = std::from_chars(first, last, value);
+    return ec == std::errc() && ptr == last;
+}
+
+POSITION_LIB_INLINE const char* find_delimiter(const char* first, const char* last)
+{
+    // Returns the first line break or field separator in [first, last)
+
+#ifdef POSITION_LIB_SIMD_SSE2
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i semicolon = _mm_set1_epi8(';');
+    const __m128i tab = _mm_set1_epi8('\t');
+    while (last - first >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, nl), _mm_cmpeq_epi8(chunk, comma)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, semicolon), _mm_cmpeq_epi8(chunk, tab)));
+        unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(match));
+        if (mask != 0)
+        {
+            return first + std::countr_zero(mask);
+        }
+        first += 16;
+    }
+#endif
+
+    while (first < last && *first != '\n' && *first != ',' && *first != ';' && *first != '\t')
+    {
+        first++;
+    }
+    return first;
+}
+
 POSITION_LIB_DETAIL_NAMESPACE_END
 
 #endif
@@ -0,0 +1,446 @@
+// **************************************************************** //
+// position-lib - Position conversion and display utilities         //
+// Version 0.1.0                                                    //
+// https://github.com/iontodirel/position-lib                       //
+// Copyright (c) 2023 Ion Todirel                                   //
+// **************************************************************** //
+//
+// position_service.hpp
+//
+// MIT License
+//
+// Copyright (c) 2023 Ion Todirel
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files(the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "position.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+POSITION_LIB_NAMESPACE_BEGIN
+
+// **************************************************************** //
+//                                                                  //
+//                                                                  //
+//                                                                  //
+//                                                                  //
+// FORMATTING SERVICE                                               //
+//                                                                  //
+//                                                                  //
+//                                                                  //
+//                                                                  //
+// **************************************************************** //
+
+// The display string passed to a callback lives in a slot owned by the
+// worker thread, and is only valid for the duration of the callback.
+// Callbacks run on a worker thread, they must not throw, which would
+// terminate the process, and must not call stop() or destroy the service.
+// The position_format given to submit() is referenced, not copied, and
+// must outlive the request
+using position_service_callback = std::function<void(const position_display_string&)>;
+
+struct position_service_request
+{
+    position_dd position;
+    position_notation notation = position_notation::dd;
+    const position_format* format = nullptr;
+    position_service_callback callback;
+};
+
+struct position_service_options
+{
+    std::size_t queue_capacity = 4096;
+    std::size_t worker_count = 1;
+    std::size_t batch_size = 32;
+};
+
+POSITION_LIB_DETAIL_NAMESPACE_BEGIN
+
+// Bounded multi producer, multi consumer queue, after Dmitry Vyukov.
+// Each cell carries a sequence number which tells producers and
+// consumers whether it is free or full for the current lap of the ring
+
+template <typename T>
+class mpmc_queue
+{
+public:
+    explicit mpmc_queue(std::size_t capacity);
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    bool try_push(T&& value);
+    bool try_pop(T& value);
+    bool empty() const;
+    std::size_t capacity() const;
+
+private:
+    struct alignas(64) cell
+    {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> enqueue_position = 0;
+    alignas(64) std::atomic<std::size_t> dequeue_position = 0;
+};
+
+POSITION_LIB_DETAIL_NAMESPACE_END
+
+class position_service
+{
+public:
+    explicit position_service(position_service_options options = {});
+    ~position_service();
+
+    position_service(const position_service&) = delete;
+    position_service& operator=(const position_service&) = delete;
+
+    bool submit(const position_dd& p, position_notation notation, const position_format& format, position_service_callback callback);
+    std::optional<std::future<position_display_string>> submit(const position_dd& p, position_notation notation, const position_format& format);
+    bool submit(const position_dd& p, position_notation notation, const position_format&& format, position_service_callback callback) = delete;
+    std::optional<std::future<position_display_string>> submit(const position_dd& p, position_notation notation, const position_format&& format) = delete;
+    void stop();
+
+private:
+    bool submit(position_service_request&& request);
+    void run();
+
+    position_service_options options;
+    POSITION_LIB_DETAIL_NAMESPACE_REFERENCE mpmc_queue<position_service_request> queue;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping = false;
+    std::atomic<int> in_flight_submits = 0;
+    std::atomic<int> sleeping_workers = 0;
+    std::atomic<std::uint32_t> wake_signal = 0;
+};
+
+// **************************************************************** //
+//                                                                  //
+// QUEUE                                                            //
+//                                                                  //
+// **************************************************************** //
+
+POSITION_LIB_DETAIL_NAMESPACE_BEGIN
+
+template <typename T>
+mpmc_queue<T>::mpmc_queue(std::size_t capacity)
+{
+    std::size_t size = 2;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+    cells = std::make_unique<cell[]>(size);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    mask = size - 1;
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_push(T&& value)
+{
+    std::size_t position = enqueue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        cell& c = cells[position & mask];
+        std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+        std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+        if (difference == 0)
+        {
+            if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                c.value = std::move(value);
+                c.sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool mpmc_queue<T>::try_pop(T& value)
+{
+    std::size_t position = dequeue_position.load(std::memory_order_relaxed);
+    while (true)
+    {
+        cell& c = cells[position & mask];
+        std::size_t sequence = c.sequence.load(std::memory_order_acquire);
+        std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+        if (difference == 0)
+        {
+            if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                value = std::move(c.value);
+                c.sequence.store(position + mask + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            return false;
+        }
+        else
+        {
+            position = dequeue_position.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T>
+bool mpmc_queue<T>::empty() const
+{
+    std::size_t position = dequeue_position.load(std::memory_order_relaxed);
+    return cells[position & mask].sequence.load(std::memory_order_acquire) != position + 1;
+}
+
+template <typename T>
+std::size_t mpmc_queue<T>::capacity() const
+{
+    return mask + 1;
+}
+
+POSITION_LIB_DETAIL_NAMESPACE_END
+
+#ifndef POSITION_LIB_PUBLIC_FORWARD_DECLARATIONS_ONLY
+
+// **************************************************************** //
+//                                                                  //
+// SERVICE                                                          //
+//                                                                  //
+// **************************************************************** //
+
+POSITION_LIB_INLINE position_service::position_service(position_service_options options) : options(options), queue(options.queue_capacity)
+{
+    std::size_t worker_count = options.worker_count == 0 ? 1 : options.worker_count;
+    for (std::size_t i = 0; i < worker_count; i++)
+    {
+        workers.emplace_back([this] { run(); });
+    }
+}
+
+POSITION_LIB_INLINE position_service::~position_service()
+{
+    stop();
+}
+
+POSITION_LIB_INLINE bool position_service::submit(const position_dd& p, position_notation notation, const position_format& format, position_service_callback callback)
+{
+    position_service_request request;
+    request.position = p;
+    request.notation = notation;
+    request.format = &format;
+    request.callback = std::move(callback);
+    return submit(std::move(request));
+}
+
+POSITION_LIB_INLINE std::optional<std::future<position_display_string>> position_service::submit(const position_dd& p, position_notation notation, const position_format& format)
+{
+    // The promise is shared with the callback, as std::function requires
+    // a copyable target, and the result is copied out of the worker's slot
+
+    auto promise = std::make_shared<std::promise<position_display_string>>();
+    std::future<position_display_string> future = promise->get_future();
+
+    if (!submit(p, notation, format, [promise](const position_display_string& s) { promise->set_value(s); }))
+    {
+        return std::nullopt;
+    }
+
+    return future;
+}
+
+POSITION_LIB_INLINE bool position_service::submit(position_service_request&& request)
+{
+    // Registers as in flight before checking stopping, so that stop()
+    // either makes us reject the request, or waits for our push to land
+    in_flight_submits.fetch_add(1, std::memory_order_seq_cst);
+
+    if (stopping.load(std::memory_order_seq_cst) || !queue.try_push(std::move(request)))
+    {
+        in_flight_submits.fetch_sub(1, std::memory_order_release);
+        return false;
+    }
+
+    // Pairs with the fence in run(), either the worker sees the request
+    // before going to sleep, or we see the worker asleep and wake it
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_workers.load(std::memory_order_relaxed) > 0)
+    {
+        wake_signal.fetch_add(1, std::memory_order_release);
+        wake_signal.notify_one();
+    }
+
+    in_flight_submits.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
+
+POSITION_LIB_INLINE void position_service::stop()
+{
+    if (stopping.exchange(true))
+    {
+        return;
+    }
+
+    // No submit can be accepted past this point, wait for those already
+    // accepted to be fully published to the queue
+    while (in_flight_submits.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    wake_signal.fetch_add(1, std::memory_order_release);
+    wake_signal.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+    workers.clear();
+
+    // Workers may have exited while a push was still being published,
+    // complete whatever they left behind on this thread
+    run();
+}
+
+POSITION_LIB_INLINE void position_service::run()
+{
+    // Requests are taken off the queue in batches, converted, then
+    // formatted into slots which are reused from one batch to the next,
+    // so that in steady state formatting does not allocate
+
+    std::size_t batch_size = options.batch_size == 0 ? 1 : options.batch_size;
+    std::vector<position_service_request> batch(batch_size);
+    std::vector<position_ddm> ddm(batch_size);
+    std::vector<position_dms> dms(batch_size);
+    std::vector<position_display_string> slots(batch_size);
+
+    for (position_display_string& slot : slots)
+    {
+        slot.lat.reserve(32);
+        slot.lon.reserve(32);
+    }
+
+    int idle_spins = 0;
+
+    while (true)
+    {
+        std::size_t count = 0;
+        while (count < batch_size && queue.try_pop(batch[count]))
+        {
+            count++;
+        }
+
+        if (count == 0)
+        {
+            if (stopping.load(std::memory_order_acquire))
+            {
+                if (queue.empty())
+                {
+                    return;
+                }
+                continue;
+            }
+
+            if (idle_spins++ < 64)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::uint32_t signal = wake_signal.load(std::memory_order_acquire);
+            sleeping_workers.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (queue.empty() && !stopping.load(std::memory_order_acquire))
+            {
+                wake_signal.wait(signal, std::memory_order_acquire);
+            }
+            sleeping_workers.fetch_sub(1, std::memory_order_relaxed);
+            idle_spins = 0;
+            continue;
+        }
+
+        idle_spins = 0;
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (batch[i].notation == position_notation::ddm)
+            {
+                ddm[i] = batch[i].position;
+            }
+            else if (batch[i].notation == position_notation::dms)
+            {
+                dms[i] = batch[i].position;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const position_format& fmt = batch[i].format != nullptr ? *batch[i].format : position_dd_format;
+            if (batch[i].notation == position_notation::ddm)
+            {
+                format(ddm[i], fmt, slots[i]);
+            }
+            else if (batch[i].notation == position_notation::dms)
+            {
+                format(dms[i], fmt, slots[i]);
+            }
+            else
+            {
+                format(batch[i].position, fmt, slots[i]);
+            }
+        }
+
+        for (std::size_t i = 0; i < count; i++)
+        {
+            if (batch[i].callback)
+            {
+                batch[i].callback(slots[i]);
+            }
+            batch[i].callback = nullptr;
+        }
+    }
+}
+
+#endif
+
+POSITION_LIB_NAMESPACE_END
@@ -0,0 +1,145 @@
+#include "../position.hpp"
+
+#include "position_benchmarks_scalar.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace position;
+
+std::string make_corpus(std::size_t records)
+{
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<double> lat_dist(-89.9, 89.9);
+    std::uniform_real_distribution<double> lon_dist(-179.9, 179.9);
+
+    std::string buffer;
+    for (std::size_t i = 0; i < records; i++)
+    {
+        position_dd dd(lat_dist(rng), lon_dist(rng));
+        position_display_string s;
+        switch (i % 3)
+        {
+        case 0: s = format(dd, position_dd_format); break;
+        case 1: s = format(position_ddm(dd), position_ddm_format); break;
+        case 2: s = format(position_dms(dd), position_dms_format); break;
+        }
+        buffer.append(s.lat);
+        buffer.append(", ");
+        buffer.append(s.lon);
+        buffer.append("\n");
+    }
+    return buffer;
+}
+
+std::size_t parse_scalar(const std::string& buffer, std::vector<position_parse_result>& results)
+{
+    // Baseline: split lines and fields with the standard library,
+    // then decode each field on its own
+
+    std::istringstream stream(buffer);
+    std::string line;
+    std::size_t count = 0;
+    while (std::getline(stream, line))
+    {
+        position_parse_result result;
+        std::size_t separator = line.find(',');
+        if (separator == std::string::npos)
+        {
+            result.status = position_parse_status::invalid_format;
+        }
+        else
+        {
+            position_parse_status lat_status = parse_coordinate(std::string_view(line).substr(0, separator), position_axis::lat, result.position.lat, result.lat_notation);
+            position_parse_status lon_status = parse_coordinate(std::string_view(line).substr(separator + 1), position_axis::lon, result.position.lon, result.lon_notation);
+            result.status = lat_status != position_parse_status::ok ? lat_status : lon_status;
+        }
+        results.push_back(result);
+        count++;
+    }
+    return count;
+}
+
+std::size_t count_delimiters(std::string_view buffer)
+{
+    std::size_t count = 0;
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    while ((p = detail::find_delimiter(p, end)) != end)
+    {
+        count++;
+        p++;
+    }
+    return count;
+}
+
+template <typename F>
+double measure(const char* name, std::size_t bytes, std::size_t records, int iterations, F f)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::size_t total = 0;
+    for (int i = 0; i < iterations; i++)
+    {
+        total += f();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double mb_per_second = (static_cast<double>(bytes) * iterations) / seconds / (1024.0 * 1024.0);
+    double ns_per_record = seconds * 1e9 / (static_cast<double>(records) * iterations);
+
+    std::cout << name << ": " << mb_per_second << " MB/s, " << ns_per_record << " ns/record (" << total << " items)" << std::endl;
+
+    return mb_per_second;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t records = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    std::string buffer = make_corpus(records);
+    std::vector<position_parse_result> results;
+    results.reserve(records);
+
+#ifdef POSITION_LIB_SIMD_SSE2
+    std::cout << "delimiter scanning: SSE2" << std::endl;
+#else
+    std::cout << "delimiter scanning: scalar" << std::endl;
+#endif
+
+    // Delimiter scanning on its own, then the full bulk parse, each with
+    // the scalar and the SIMD scan, and a per-field std::getline baseline
+
+    double scan_scalar = measure("scan, scalar            ", buffer.size(), records, iterations, [&] {
+        return count_delimiters_scalar_scan(buffer);
+    });
+
+    double scan_simd = measure("scan, SIMD              ", buffer.size(), records, iterations, [&] {
+        return count_delimiters(buffer);
+    });
+
+    double per_field = measure("per-field std::getline  ", buffer.size(), records, iterations, [&] {
+        results.clear();
+        return parse_scalar(buffer, results);
+    });
+
+    double bulk_scalar = measure("parse_positions, scalar ", buffer.size(), records, iterations, [&] {
+        return parse_positions_scalar_scan(buffer);
+    });
+
+    double bulk_simd = measure("parse_positions, SIMD   ", buffer.size(), records, iterations, [&] {
+        results.clear();
+        return parse_positions(buffer, results);
+    });
+
+    std::cout << "scan speedup, SIMD over scalar: " << scan_simd / scan_scalar << "x" << std::endl;
+    std::cout << "parse speedup, SIMD over scalar scan: " << bulk_simd / bulk_scalar << "x" << std::endl;
+    std::cout << "parse speedup, SIMD over per-field: " << bulk_simd / per_field << "x" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,29 @@
+// Compiles the library a second time with SIMD disabled, in its own
+// namespace, so that both delimiter scans can be compared in one run
+
+#define POSITION_LIB_NO_SIMD
+#define POSITION_LIB_NAMESPACE_BEGIN namespace position_scalar {
+#define POSITION_LIB_NAMESPACE_END }
+#include "../position.hpp"
+
+#include "position_benchmarks_scalar.h"
+
+std::size_t parse_positions_scalar_scan(std::string_view buffer)
+{
+    static std::vector<position_scalar::position_parse_result> results;
+    results.clear();
+    return position_scalar::parse_positions(buffer, results);
+}
+
+std::size_t count_delimiters_scalar_scan(std::string_view buffer)
+{
+    std::size_t count = 0;
+    const char* p = buffer.data();
+    const char* end = p + buffer.size();
+    while ((p = position_scalar::detail::find_delimiter(p, end)) != end)
+    {
+        count++;
+        p++;
+    }
+    return count;
+}
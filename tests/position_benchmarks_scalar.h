@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+std::size_t parse_positions_scalar_scan(std::string_view buffer);
+std::size_t count_delimiters_scalar_scan(std::string_view buffer);
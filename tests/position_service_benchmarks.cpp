@@ -0,0 +1,148 @@
+#include "../position_service.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace position;
+
+using benchmark_clock = std::chrono::steady_clock;
+
+struct latency_record
+{
+    benchmark_clock::time_point submitted;
+    benchmark_clock::time_point completed;
+};
+
+std::vector<position_dd> make_positions(std::size_t count)
+{
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<double> lat_dist(-89.9, 89.9);
+    std::uniform_real_distribution<double> lon_dist(-179.9, 179.9);
+
+    std::vector<position_dd> positions;
+    positions.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        positions.emplace_back(lat_dist(rng), lon_dist(rng));
+    }
+    return positions;
+}
+
+double percentile(std::vector<double>& values, double p)
+{
+    std::size_t index = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void run_direct(const std::vector<position_dd>& positions, std::size_t producer_count, std::size_t requests_per_producer)
+{
+    // Baseline: every producer calls format() itself
+
+    std::vector<double> latencies(producer_count * requests_per_producer);
+    std::atomic<std::size_t> sink = 0;
+
+    auto start = benchmark_clock::now();
+
+    std::vector<std::thread> producers;
+    for (std::size_t p = 0; p < producer_count; p++)
+    {
+        producers.emplace_back([&, p] {
+            std::size_t length = 0;
+            for (std::size_t i = 0; i < requests_per_producer; i++)
+            {
+                std::size_t index = p * requests_per_producer + i;
+                auto submitted = benchmark_clock::now();
+                position_display_string s = format(position_ddm(positions[index % positions.size()]), position_ddm_format);
+                latencies[index] = std::chrono::duration<double, std::micro>(benchmark_clock::now() - submitted).count();
+                length += s.lat.size();
+            }
+            sink += length;
+        });
+    }
+    for (std::thread& t : producers)
+    {
+        t.join();
+    }
+
+    double seconds = std::chrono::duration<double>(benchmark_clock::now() - start).count();
+
+    std::cout << "direct format():  "
+        << static_cast<double>(latencies.size()) / seconds << " req/s, "
+        << "p50 " << percentile(latencies, 0.50) << " us, "
+        << "p99 " << percentile(latencies, 0.99) << " us" << std::endl;
+}
+
+void run_service(const std::vector<position_dd>& positions, std::size_t producer_count, std::size_t requests_per_producer, position_service_options options)
+{
+    std::vector<latency_record> records(producer_count * requests_per_producer);
+    std::atomic<std::size_t> rejected = 0;
+
+    auto start = benchmark_clock::now();
+
+    {
+        position_service service(options);
+
+        std::vector<std::thread> producers;
+        for (std::size_t p = 0; p < producer_count; p++)
+        {
+            producers.emplace_back([&, p] {
+                for (std::size_t i = 0; i < requests_per_producer; i++)
+                {
+                    std::size_t index = p * requests_per_producer + i;
+                    latency_record* record = &records[index];
+                    record->submitted = benchmark_clock::now();
+                    auto callback = [record](const position_display_string&) { record->completed = benchmark_clock::now(); };
+                    while (!service.submit(positions[index % positions.size()], position_notation::ddm, position_ddm_format, callback))
+                    {
+                        rejected++;
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::thread& t : producers)
+        {
+            t.join();
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(benchmark_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    latencies.reserve(records.size());
+    for (const latency_record& record : records)
+    {
+        latencies.push_back(std::chrono::duration<double, std::micro>(record.completed - record.submitted).count());
+    }
+
+    std::cout << "position_service: "
+        << static_cast<double>(latencies.size()) / seconds << " req/s, "
+        << "p50 " << percentile(latencies, 0.50) << " us, "
+        << "p99 " << percentile(latencies, 0.99) << " us, "
+        << rejected.load() << " rejected submits" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    std::size_t producer_count = argc > 1 ? std::stoul(argv[1]) : 4;
+    std::size_t worker_count = argc > 2 ? std::stoul(argv[2]) : 2;
+    std::size_t requests_per_producer = argc > 3 ? std::stoul(argv[3]) : 200000;
+
+    std::cout << producer_count << " producers, " << worker_count << " workers, "
+        << requests_per_producer << " requests per producer, "
+        << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    std::vector<position_dd> positions = make_positions(4096);
+
+    run_direct(positions, producer_count, requests_per_producer);
+    run_service(positions, producer_count, requests_per_producer, { .queue_capacity = 4096, .worker_count = worker_count, .batch_size = 32 });
+
+    return 0;
+}
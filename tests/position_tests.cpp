@@ -1,11 +1,16 @@
 #include <gtest/gtest.h>
 
 #include "../position.hpp"
+#include "../position_service.hpp"
 
 #include <filesystem>
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <random>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 using namespace position;
 
@@ -125,6 +130,368 @@ TEST(Position, FormattingEiffelTower)
     EXPECT_TRUE(dms_fmt.lon == "2°17'40.13\"E");
 }
 
+TEST(Position, ParseCoordinate)
+{
+    struct corpus_entry
+    {
+        std::string text;
+        position_axis axis;
+        position_parse_status status;
+        position_notation notation;
+        double value;
+    };
+
+    std::vector<corpus_entry> corpus = {
+        { "47.6205", position_axis::lat, position_parse_status::ok, position_notation::dd, 47.6205 },
+        { "-122.3493", position_axis::lon, position_parse_status::ok, position_notation::dd, -122.3493 },
+        { "+2.294481", position_axis::lon, position_parse_status::ok, position_notation::dd, 2.294481 },
+        { "47.6205°N", position_axis::lat, position_parse_status::ok, position_notation::dd, 47.6205 },
+        { "122.3493 W", position_axis::lon, position_parse_status::ok, position_notation::dd, -122.3493 },
+        { "47°37.230'N", position_axis::lat, position_parse_status::ok, position_notation::ddm, 47.6205 },
+        { "122°20.958'W", position_axis::lon, position_parse_status::ok, position_notation::ddm, -122.3493 },
+        { "47d37.230'N", position_axis::lat, position_parse_status::ok, position_notation::ddm, 47.6205 },
+        { "47 37.230 N", position_axis::lat, position_parse_status::ok, position_notation::ddm, 47.6205 },
+        { "S 47 37.230", position_axis::lat, position_parse_status::ok, position_notation::ddm, -47.6205 },
+        { "-47º37.230′", position_axis::lat, position_parse_status::ok, position_notation::ddm, -47.6205 },
+        { "4851.51N", position_axis::lat, position_parse_status::ok, position_notation::ddm, 48.8585 },
+        { "00217.67E", position_axis::lon, position_parse_status::ok, position_notation::ddm, 2.294500 },
+        { "47°37'13.80\"N", position_axis::lat, position_parse_status::ok, position_notation::dms, 47.6205 },
+        { "122°20'57.48\"W", position_axis::lon, position_parse_status::ok, position_notation::dms, -122.3493 },
+        { "47:37:13.80N", position_axis::lat, position_parse_status::ok, position_notation::dms, 47.6205 },
+        { "47d 37' 13.80'' N", position_axis::lat, position_parse_status::ok, position_notation::dms, 47.6205 },
+        { "47°37′13.80″N", position_axis::lat, position_parse_status::ok, position_notation::dms, 47.6205 },
+        { " 47 37 13.80 N \r", position_axis::lat, position_parse_status::ok, position_notation::dms, 47.6205 },
+        { "", position_axis::lat, position_parse_status::empty, position_notation::unknown, 0.0 },
+        { "   ", position_axis::lat, position_parse_status::empty, position_notation::unknown, 0.0 },
+        { "abc", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "47.5.1", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "47.5°37'N", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "47'37°N", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "-47.6205N", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "47 37 13 1", position_axis::lat, position_parse_status::invalid_format, position_notation::unknown, 0.0 },
+        { "47.6205E", position_axis::lat, position_parse_status::invalid_hemisphere, position_notation::unknown, 0.0 },
+        { "122.3493N", position_axis::lon, position_parse_status::invalid_hemisphere, position_notation::unknown, 0.0 },
+        { "120.0N", position_axis::lat, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+        { "217.67E", position_axis::lon, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+        { "91.0", position_axis::lat, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+        { "-180.5", position_axis::lon, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+        { "47°60.0'N", position_axis::lat, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+        { "47°37'60\"N", position_axis::lat, position_parse_status::out_of_range, position_notation::unknown, 0.0 },
+    };
+
+    for (const corpus_entry& entry : corpus)
+    {
+        double value = 0.0;
+        position_notation notation = position_notation::unknown;
+        position_parse_status status = parse_coordinate(entry.text, entry.axis, value, notation);
+        EXPECT_TRUE(status == entry.status) << entry.text;
+        EXPECT_TRUE(notation == entry.notation) << entry.text;
+        EXPECT_NEAR(value, entry.value, 0.0001) << entry.text;
+    }
+}
+
+TEST(Position, ParsePositionsStatuses)
+{
+    std::string buffer =
+        "47.620500,-122.349300\n"
+        "47°37.230'N;122°20.958'W\r\n"
+        "\n"
+        "47°37'13.80\"N\t122°20'57.48\"W\n"
+        "47.620500\n"
+        "1,2,3\n"
+        "47.6205E,122.3493W\n"
+        "95.0, 10.0\n"
+        "4851.51N, 00217.67E";
+
+    std::vector<position_parse_result> results = parse_positions(buffer);
+    ASSERT_EQ(results.size(), 9u);
+
+    EXPECT_TRUE(results[0].status == position_parse_status::ok);
+    EXPECT_TRUE(results[0].lat_notation == position_notation::dd);
+    EXPECT_TRUE(results[1].status == position_parse_status::ok);
+    EXPECT_TRUE(results[1].lat_notation == position_notation::ddm);
+    EXPECT_TRUE(results[2].status == position_parse_status::empty);
+    EXPECT_TRUE(results[3].status == position_parse_status::ok);
+    EXPECT_TRUE(results[3].lon_notation == position_notation::dms);
+    EXPECT_TRUE(results[4].status == position_parse_status::invalid_format);
+    EXPECT_TRUE(results[5].status == position_parse_status::invalid_format);
+    EXPECT_TRUE(results[6].status == position_parse_status::invalid_hemisphere);
+    EXPECT_TRUE(results[7].status == position_parse_status::out_of_range);
+    EXPECT_TRUE(results[8].status == position_parse_status::ok);
+
+    for (std::size_t i : { 0, 1, 3 })
+    {
+        EXPECT_NEAR(results[i].position.lat, 47.6205, 0.000001);
+        EXPECT_NEAR(results[i].position.lon, -122.3493, 0.000001);
+    }
+    EXPECT_NEAR(results[8].position.lat, 48.8585, 0.000001);
+    EXPECT_NEAR(results[8].position.lon, 2.2945, 0.000001);
+
+    EXPECT_TRUE(parse_positions("").empty());
+    EXPECT_EQ(parse_positions("1,2\n").size(), 1u);
+}
+
+TEST(Position, ParsePositionsFormattedCorpus)
+{
+    // Round trip randomly generated positions through every built-in
+    // format, plus a few hand-rolled variants, and parse them back in bulk
+
+    position_format ddm_d_format = position_ddm_format;
+    ddm_d_format.deg_symbol = "d";
+    position_format dms_spaced_format = position_dms_format;
+    dms_spaced_format.deg_symbol = "";
+    dms_spaced_format.min_symbol = " ";
+    dms_spaced_format.sec_symbol = "";
+    dms_spaced_format.dm_separator = " ";
+    dms_spaced_format.dir_indicator_spacer = " ";
+
+    std::mt19937 rng(2023);
+    std::uniform_real_distribution<double> lat_dist(-89.9, 89.9);
+    std::uniform_real_distribution<double> lon_dist(-179.9, 179.9);
+    const char* separators[] = { ",", ", ", ";", "\t" };
+
+    std::vector<position_dd> expected;
+    std::vector<double> tolerance;
+    std::string buffer;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        position_dd dd(lat_dist(rng), lon_dist(rng));
+        position_ddm ddm = dd;
+        position_dms dms = dd;
+
+        // Skip values the formatter itself renders ambiguously: minutes or
+        // seconds rounding up to 60, and the short DDM format which does not
+        // zero pad degrees or minutes like NMEA and APRS do
+        if (ddm.lat_m > 59.99 || ddm.lon_m > 59.99 || dms.lat_s > 59.99 || dms.lon_s > 59.99)
+        {
+            continue;
+        }
+        if (i % 6 == 2 && (std::abs(dd.lat) < 10.0 || std::abs(dd.lon) < 100.0 || ddm.lat_m < 10.0 || ddm.lon_m < 10.0))
+        {
+            continue;
+        }
+
+        position_display_string s;
+        double t = 0.0;
+        switch (i % 6)
+        {
+        case 0: s = format(dd, position_dd_format); t = 0.000001; break;
+        case 1: s = format(ddm, position_ddm_format); t = 0.001 / 60.0; break;
+        case 2: s = format(ddm, position_ddm_short_format); t = 0.01 / 60.0; break;
+        case 3: s = format(dms, position_dms_format); t = 0.01 / 3600.0; break;
+        case 4: s = format(ddm, ddm_d_format); t = 0.001 / 60.0; break;
+        case 5: s = format(dms, dms_spaced_format); t = 0.01 / 3600.0; break;
+        }
+
+        buffer.append(s.lat);
+        buffer.append(separators[i % 4]);
+        buffer.append(s.lon);
+        buffer.append(i % 3 == 0 ? "\r\n" : "\n");
+
+        expected.push_back(dd);
+        tolerance.push_back(t);
+    }
+
+    std::vector<position_parse_result> results = parse_positions(buffer);
+    ASSERT_EQ(results.size(), expected.size());
+
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        EXPECT_TRUE(results[i].status == position_parse_status::ok) << i;
+        EXPECT_NEAR(results[i].position.lat, expected[i].lat, tolerance[i]) << i;
+        EXPECT_NEAR(results[i].position.lon, expected[i].lon, tolerance[i]) << i;
+    }
+}
+
+TEST(PositionDetail, mpmc_queue)
+{
+    detail::mpmc_queue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    EXPECT_TRUE(queue.empty());
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.try_push(int(i)));
+    }
+    EXPECT_FALSE(queue.try_push(4));
+    EXPECT_FALSE(queue.empty());
+
+    int value = -1;
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(queue.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.try_pop(value));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(PositionDetail, mpmc_queue_contention)
+{
+    detail::mpmc_queue<int> queue(64);
+    constexpr int producer_count = 4;
+    constexpr int items_per_producer = 20000;
+    std::atomic<long long> sum = 0;
+    std::atomic<int> popped = 0;
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producer_count; p++)
+    {
+        threads.emplace_back([&, p] {
+            for (int i = 1; i <= items_per_producer; i++)
+            {
+                while (!queue.try_push(p * items_per_producer + i))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        threads.emplace_back([&] {
+            int value;
+            while (popped.load() < producer_count * items_per_producer)
+            {
+                if (queue.try_pop(value))
+                {
+                    sum += value;
+                    popped++;
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread& t : threads)
+    {
+        t.join();
+    }
+
+    long long n = producer_count * items_per_producer;
+    EXPECT_EQ(sum.load(), n * (n + 1) / 2);
+}
+
+TEST(Position, ServiceFormatting)
+{
+    position_service service({ .queue_capacity = 16, .worker_count = 2, .batch_size = 4 });
+
+    position_dd dd(47.620500, -122.349300);
+
+    auto dd_fmt = service.submit(dd, position_notation::dd, position_dd_format);
+    auto ddm_fmt = service.submit(dd, position_notation::ddm, position_ddm_format);
+    auto dms_fmt = service.submit(dd, position_notation::dms, position_dms_format);
+    ASSERT_TRUE(dd_fmt && ddm_fmt && dms_fmt);
+
+    position_display_string s = dd_fmt->get();
+    EXPECT_TRUE(s.lat == "47.620500");
+    EXPECT_TRUE(s.lon == "-122.349300");
+    s = ddm_fmt->get();
+    EXPECT_TRUE(s.lat == "47°37.230'N");
+    EXPECT_TRUE(s.lon == "122°20.958'W");
+    s = dms_fmt->get();
+    EXPECT_TRUE(s.lat == "47°37'13.80\"N");
+    EXPECT_TRUE(s.lon == "122°20'57.48\"W");
+}
+
+TEST(Position, ServiceCallbacksUnderContention)
+{
+    constexpr int producer_count = 4;
+    constexpr int requests_per_producer = 5000;
+    std::atomic<int> completed = 0;
+    std::atomic<int> mismatched = 0;
+
+    {
+        position_service service({ .queue_capacity = 256, .worker_count = 2 });
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producer_count; p++)
+        {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < requests_per_producer; i++)
+                {
+                    position_dd dd(p, -i / 100.0);
+                    std::string expected = format(dd, position_dd_format).lon;
+                    auto callback = [&completed, &mismatched, expected](const position_display_string& s) {
+                        if (s.lon != expected)
+                        {
+                            mismatched++;
+                        }
+                        completed++;
+                    };
+                    while (!service.submit(dd, position_notation::dd, position_dd_format, callback))
+                    {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::thread& t : producers)
+        {
+            t.join();
+        }
+    }
+
+    // The service destructor drains every accepted request
+    EXPECT_EQ(completed.load(), producer_count * requests_per_producer);
+    EXPECT_EQ(mismatched.load(), 0);
+}
+
+TEST(Position, ServiceStopWhileSubmitting)
+{
+    // Every request accepted by submit() must have completed by the time
+    // stop() returns, including those which race with it
+
+    for (int round = 0; round < 20; round++)
+    {
+        std::atomic<int> accepted = 0;
+        std::atomic<int> completed = 0;
+        std::atomic<bool> started = false;
+
+        position_service service({ .queue_capacity = 64, .worker_count = 2, .batch_size = 4 });
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; p++)
+        {
+            producers.emplace_back([&] {
+                for (int i = 0; i < 2000; i++)
+                {
+                    if (service.submit(position_dd(1.0, 2.0), position_notation::dd, position_dd_format, [&completed](const position_display_string&) { completed++; }))
+                    {
+                        accepted++;
+                    }
+                    started = true;
+                }
+            });
+        }
+
+        while (!started)
+        {
+            std::this_thread::yield();
+        }
+        service.stop();
+        int completed_at_stop = completed.load();
+
+        for (std::thread& t : producers)
+        {
+            t.join();
+        }
+
+        EXPECT_EQ(completed_at_stop, accepted.load());
+        EXPECT_EQ(completed.load(), accepted.load());
+    }
+}
+
+TEST(Position, ServiceRejectsAfterStop)
+{
+    position_service service;
+    service.stop();
+    EXPECT_FALSE(service.submit(position_dd(1.0, 2.0), position_notation::dd, position_dd_format).has_value());
+}
+
 int main(int argc, char** argv)
 {
     ::testing::InitGoogleTest(&argc, argv);